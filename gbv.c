@@ -1,7 +1,11 @@
+// Necessario para posix_fadvise e fileno
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
 
 #include "gbv.h"
 #include "util.h"
@@ -17,9 +21,48 @@ Document *gbv;
 // Facilita o acesso ao nome do arquivo em diferentes funcoes sem passa-lo como parametro
 static char GBV_ARCHIVE_NAME[MAX_ARCHIVE_PATH] = {0}; 
 
+// Indica se a biblioteca aberta e um snapshot (somente leitura)
+static int GBV_READ_ONLY = 0;
+
+// Tamanho do bloco exibido por gbv_view, alterado por gbv_set_view_block_size
+static long GBV_VIEW_BLOCK_SIZE = BUFFER_SIZE;
+
+// Quantidade de paginas (blocos) mantidas na cache de visualizacao
+#define GBV_CACHE_PAGES 8
+// Quantos blocos sao lidos de uma vez na direcao da navegacao
+#define GBV_READAHEAD 4
+
+// Pagina da cache: guarda um bloco do documento em visualizacao
+typedef struct {
+    long block;              // indice do bloco dentro do documento (-1 = livre)
+    size_t len;              // bytes validos em data
+    unsigned long last_use;  // marca de uso para politica LRU
+    char *data;
+} GBV_CachePage;
+
+// Cache LRU associada a um arquivo aberto por gbv_view
+typedef struct {
+    FILE *fp;
+    long doc_offset;
+    long doc_size;
+    long block_size;
+    unsigned long tick;      // contador incrementado a cada acesso
+    long hinted;             // primeiro bloco da ultima janela sugerida ao kernel (-1 = nenhuma)
+    GBV_CachePage pages[GBV_CACHE_PAGES];
+    char *area;              // memoria das paginas (GBV_CACHE_PAGES blocos)
+    char *scratch;           // buffer da leitura antecipada (GBV_READAHEAD blocos)
+} GBV_ViewCache;
+
 // Prototipo para funcoes auxiliares
 static int gbv_find_document_index(const Library *lib, const char *docname);
 static int gbv_persist_metadata (Library *lib);
+static int gbv_load_directory (Library *lib, FILE *fp);
+static int gbv_snapshot_path (const char *archive, const char *snapname, char *path);
+static int gbv_valid_snapshot_name (const char *snapname);
+static int gbv_check_writable (const char *who);
+static int view_cache_init (GBV_ViewCache *cache, FILE *fp, long doc_offset, long doc_size, long block_size);
+static void view_cache_free (GBV_ViewCache *cache);
+static GBV_CachePage *view_cache_get (GBV_ViewCache *cache, long block, int direction);
 static int compare_name (const void *a, const void *b);
 static int compare_date (const void *a, const void *b);
 static int compare_size (const void *a, const void *b);
@@ -85,49 +128,12 @@ int gbv_open (Library *lib, const char *filename) {
     // Armazena o nome do arquivo na variavel global para outras operacoes
     strncpy (GBV_ARCHIVE_NAME, filename, MAX_ARCHIVE_PATH - 1);
     GBV_ARCHIVE_NAME[MAX_ARCHIVE_PATH - 1] = '\0';
+    GBV_READ_ONLY = 0;
 
-    // Le o superbloco do inicio do arquivo para informacoes essenciais
-    GBV_Superblock sb;
-    if (fread (&sb, sizeof (GBV_Superblock), 1, fp) != 1) {
-        perror ("gbv_open: Erro ao ler o superbloco da biblioteca.\n");
-        fclose (fp);
-        return -1;
-    }
-
-    // Transfere as info. do superbloco para a estrutura Library em memoria
-    lib->count = sb.count;
-    lib->docs = NULL;
-
-    // Se tem documentos carrega diretorio para memoria
-    if (lib->count > 0) {
-        // Aloca a memoria necessaria para diretorio
-        lib->docs = (Document *) malloc (lib->count * sizeof (Document));
-        if (lib->docs == NULL) {
-            perror ("gbv_open: Falha na alocacao da memoria para o diretorio.\n");
-            fclose (fp);
-            return -1;
-        }
-
-        // Posiciona o cursor do arquivo onde diretorio esta armazenado
-        if (fseek (fp, sb.dir_offset, SEEK_SET) != 0) {
-            perror ("gbv_open: Erro ao posicionar para a area de diretorio.\n");
-            free (lib->docs);
-            fclose (fp);
-            return -1;
-        }
-
-        // Le todos metadados do diretorio para estrutura em memoria
-        size_t read_count = fread (lib->docs, sizeof (Document), lib->count, fp);
-        if (read_count != lib->count) {
-            perror ("gbv_open: Erro ao ler diretorio.\n");
-            free (lib->docs);
-            fclose (fp);
-            return -1;
-        }
-    }
+    int status = gbv_load_directory (lib, fp);
     fclose (fp);
 
-    return 0;
+    return status;
 }
 
 /**
@@ -139,6 +145,10 @@ int gbv_open (Library *lib, const char *filename) {
  * return 0 sucesso, -1 erro
  */
 int gbv_add (Library *lib, const char *archive, const char *docname) {
+    if (gbv_check_writable ("gbv_add") != 0) {
+        return -1;
+    }
+
     FILE *doc_fp = fopen (docname, "rb");
     if (doc_fp == NULL) {
         perror ("gbv_add: Erro ao abrir o documento de origem.\n");
@@ -269,6 +279,10 @@ int gbv_add (Library *lib, const char *archive, const char *docname) {
  * return 0 sucesso, -1 erro
  */
 int gbv_remove (Library *lib, const char *docname) {
+    if (gbv_check_writable ("gbv_remove") != 0) {
+        return -1;
+    }
+
     // Procura pelo indice do documento a ser removido
     int index = gbv_find_document_index (lib, docname);
     if (index == -1) {
@@ -345,6 +359,7 @@ int gbv_list (const Library *lib) {
 
 /**
  * Vizualiza o conteudo de um documento em blocos com tam. fixo
+ * Os blocos passam por uma cache LRU com leitura antecipada na direcao da navegacao
  * Recebe como parametro:
  * - Ponteiro para a estrutura da biblioteca (lib)
  * - Nome do documento a ser visualizado (docname)
@@ -366,56 +381,91 @@ int gbv_view (const Library *lib, const char *docname) {
     // Obetem infos do documento do diretorio
     long doc_offset = lib->docs[index].offset;
     long doc_size = lib->docs[index].size;
-    long current_pos = 0; // Posicao atual de visualizacao dentro do doc
+    long block_size = GBV_VIEW_BLOCK_SIZE;
+    long last_block = doc_size > 0 ? (doc_size - 1) / block_size : 0;
+    long current_block = 0; // Bloco atual de visualizacao dentro do doc
+    int direction = 1;      // Direcao da navegacao, guia a leitura antecipada
+
+    GBV_ViewCache cache;
+    if (view_cache_init (&cache, fp, doc_offset, doc_size, block_size) != 0) {
+        perror ("gbv_view: Erro ao alocar a cache de visualizacao.\n");
+        fclose (fp);
+        return -1;
+    }
 
-    char buffer[BUFFER_SIZE];
     char command;
 
     // Loop de navegacao
     do {
+        long current_pos = current_block * block_size;
+
         // Exibe cabeçalho com infos e comandos
         printf ("\n--- Visualizando '%s' (Tamanho: %ld bytes) | Exibindo a partir do byte: %ld ---\n", 
                 docname, doc_size, current_pos);
-        printf("--- Comandos: [n] próximo bloco, [p] bloco anterior, [q] sair ---\n\n");
-        
-        // Posiciona o cursor no local exato do bloco a ser lido
-        if (fseek (fp, doc_offset + current_pos, SEEK_SET) != 0) {
-            perror ("gbv_view: Erro ao posicionar o ponteiro de leitura.\n");
-            break;
-        }
+        printf("--- Comandos: [n] próximo bloco, [p] bloco anterior, [g <byte>] ir para byte, [%% <0-100>] ir para porcentagem, [q] sair ---\n\n");
 
-        // Calcula quantos bytes ler para nao ultrapassar final do doc
-        size_t to_read = (size_t) ((doc_size - current_pos) < BUFFER_SIZE ? (doc_size - current_pos) : BUFFER_SIZE);
-        size_t bytes_read = fread (buffer, 1, to_read, fp);
-        if (bytes_read > 0) { 
-            // Imprime conteudo do buffer diretaente na saida padrao
-            fwrite (buffer, 1, bytes_read, stdout);
+        if (doc_size > 0) {
+            GBV_CachePage *page = view_cache_get (&cache, current_block, direction);
+            if (page == NULL) {
+                perror ("gbv_view: Erro ao ler bloco do documento.\n");
+                break;
+            }
+            // Imprime conteudo do bloco diretaente na saida padrao
+            fwrite (page->data, 1, page->len, stdout);
         }
         
         // Tentar substituir 'scanf' por 'fgets' para evitar erros no buffer
         printf ("\n\nComando> ");
-        char input[8];
+        char input[32];
+        long arg = 0;
+        int has_arg = 0;
         if (fgets (input, sizeof (input), stdin) == NULL) {
             command = 'q';
         } else {
             command = input[0];
+
+            // Argumento numerico opcional (usado por 'g' e '%')
+            char *end;
+            arg = strtol (input + 1, &end, 10);
+            has_arg = (end != input + 1);
         }
 
         switch (command) {
             case 'n': // Próximo
-                if (current_pos + BUFFER_SIZE < doc_size) {
-                    current_pos += BUFFER_SIZE;
+                if (current_block < last_block) {
+                    current_block++;
+                    direction = 1;
                 } else {
                     printf("Já está no último bloco.\n");
                 }
                 break;
             case 'p': // Anterior
-                if (current_pos - BUFFER_SIZE >= 0) {
-                    current_pos -= BUFFER_SIZE;
+                if (current_block > 0) {
+                    current_block--;
+                    direction = -1;
                 } else {
                     printf("Já está no primeiro bloco.\n");
                 }
                 break;
+            case 'g': // Ir para byte
+                if (!has_arg || arg < 0 || arg >= (doc_size > 0 ? doc_size : 1)) {
+                    printf("Offset inválido. Use 'g <byte>' com 0 <= byte < %ld.\n", doc_size > 0 ? doc_size : 1);
+                } else {
+                    current_block = arg / block_size;
+                    direction = 1;
+                }
+                break;
+            case '%': // Ir para porcentagem
+                if (!has_arg || arg < 0 || arg > 100) {
+                    printf("Porcentagem inválida. Use '%% <0-100>'.\n");
+                } else {
+                    current_block = (long) ((double) doc_size * arg / 100.0) / block_size;
+                    if (current_block > last_block) {
+                        current_block = last_block;
+                    }
+                    direction = 1;
+                }
+                break;
             case 'q': // Sair
                 printf("Saindo da visualização...\n");
                 break;
@@ -425,6 +475,7 @@ int gbv_view (const Library *lib, const char *docname) {
         }
     } while (command != 'q');
 
+    view_cache_free (&cache);
     fclose (fp);
     return 0;
 }
@@ -438,6 +489,10 @@ int gbv_view (const Library *lib, const char *docname) {
  * retur 0 sucesso, -1 erro
  */
 int gbv_order (Library *lib, const char *archive, const char *criteria) {
+    if (gbv_check_writable ("gbv_order") != 0) {
+        return -1;
+    }
+
     if (lib->count < 2) {
         printf ("Nao ha documentos suficientes para ordenar.\n");
         return 0;
@@ -471,6 +526,72 @@ int gbv_order (Library *lib, const char *archive, const char *criteria) {
     return 0;
 }
 
+/**
+ * Cria um snapshot do container em '<archive>@<snapname>'
+ * Usa reflink (FICLONE) quando o sistema de arquivos suporta (btrfs, XFS), em tempo
+ * constante e compartilhando os blocos com a biblioteca; senao faz uma copia esparsa
+ * Recebe como parametro:
+ * - Nome do arquivo container (archive)
+ * - Nome do snapshot (snapname)
+ * return 0 sucesso, -1 erro
+ */
+int gbv_snapshot (const char *archive, const char *snapname) {
+    char path[MAX_ARCHIVE_PATH];
+    if (gbv_snapshot_path (archive, snapname, path) != 0) {
+        return -1;
+    }
+
+    // Diferente de gbv_open, nunca cria a biblioteca de origem
+    FILE *fp = fopen (archive, "rb");
+    if (fp == NULL) {
+        printf ("Erro: Biblioteca '%s' nao encontrada.\n", archive);
+        return -1;
+    }
+    fclose (fp);
+
+    int reflinked;
+    if (clone_file (archive, path, &reflinked) != 0) {
+        perror ("gbv_snapshot: Erro ao criar o snapshot");
+        return -1;
+    }
+
+    printf ("Snapshot '%s' criado com sucesso (%s).\n", path,
+            reflinked ? "reflink, blocos compartilhados" : "copia esparsa");
+    return 0;
+}
+
+/**
+ * Abre um snapshot existente em modo somente leitura
+ * Apos a abertura, gbv_add, gbv_remove e gbv_order sao recusados
+ * Recebe como parametro:
+ * - Ponteiro para a estrutura Library (lib)
+ * - Nome do arquivo container de origem (archive)
+ * - Nome do snapshot (snapname)
+ * return 0 sucesso, -1 erro
+ */
+int gbv_open_snapshot (Library *lib, const char *archive, const char *snapname) {
+    char path[MAX_ARCHIVE_PATH];
+    if (gbv_snapshot_path (archive, snapname, path) != 0) {
+        return -1;
+    }
+
+    // Diferente de gbv_open, nunca cria o arquivo
+    FILE *fp = fopen (path, "rb");
+    if (fp == NULL) {
+        perror ("gbv_open_snapshot: Erro ao abrir o snapshot");
+        return -1;
+    }
+
+    strncpy (GBV_ARCHIVE_NAME, path, MAX_ARCHIVE_PATH - 1);
+    GBV_ARCHIVE_NAME[MAX_ARCHIVE_PATH - 1] = '\0';
+    GBV_READ_ONLY = 1;
+
+    int status = gbv_load_directory (lib, fp);
+    fclose (fp);
+
+    return status;
+}
+
 /**
  * Libera memoria alocada para o diretorio da biblioteca
  * Recebe como parametro:
@@ -485,6 +606,22 @@ void gbv_close (Library *lib) {
     lib->count = 0;
 }
 
+/**
+ * Define o tamanho do bloco exibido por gbv_view
+ * Recebe como parametro:
+ * - Tamanho do bloco em bytes, entre MIN_VIEW_BLOCK e MAX_VIEW_BLOCK (size)
+ * return 0 sucesso, -1 erro
+ */
+int gbv_set_view_block_size (long size) {
+    if (size < MIN_VIEW_BLOCK || size > MAX_VIEW_BLOCK) {
+        printf ("Erro: Tamanho de bloco invalido: %ld (use entre %d e %d bytes).\n",
+                size, MIN_VIEW_BLOCK, MAX_VIEW_BLOCK);
+        return -1;
+    }
+    GBV_VIEW_BLOCK_SIZE = size;
+    return 0;
+}
+
 //----------------------------------------------------------------------------------------//
 // FUNCOES AUXILIARES
 //----------------------------------------------------------------------------------------//
@@ -504,6 +641,97 @@ static int gbv_find_document_index(const Library *lib, const char *docname) {
     return -1;
 }
 
+/**
+ * Le o superbloco e carrega o diretorio do container para memoria
+ * Recebe como parametro:
+ * - Ponteiro para a estrutura Library (lib)
+ * - Arquivo container aberto para leitura (fp)
+ * return 0 sucesso, -1 erro
+ */
+static int gbv_load_directory (Library *lib, FILE *fp) {
+    // Le o superbloco do inicio do arquivo para informacoes essenciais
+    GBV_Superblock sb;
+    if (fread (&sb, sizeof (GBV_Superblock), 1, fp) != 1) {
+        perror ("gbv_load_directory: Erro ao ler o superbloco da biblioteca.\n");
+        return -1;
+    }
+
+    // Transfere as info. do superbloco para a estrutura Library em memoria
+    lib->count = sb.count;
+    lib->docs = NULL;
+
+    // Se tem documentos carrega diretorio para memoria
+    if (lib->count > 0) {
+        // Aloca a memoria necessaria para diretorio
+        lib->docs = (Document *) malloc (lib->count * sizeof (Document));
+        if (lib->docs == NULL) {
+            perror ("gbv_load_directory: Falha na alocacao da memoria para o diretorio.\n");
+            return -1;
+        }
+
+        // Posiciona o cursor do arquivo onde diretorio esta armazenado
+        if (fseek (fp, sb.dir_offset, SEEK_SET) != 0) {
+            perror ("gbv_load_directory: Erro ao posicionar para a area de diretorio.\n");
+            free (lib->docs);
+            lib->docs = NULL;
+            return -1;
+        }
+
+        // Le todos metadados do diretorio para estrutura em memoria
+        size_t read_count = fread (lib->docs, sizeof (Document), lib->count, fp);
+        if (read_count != lib->count) {
+            perror ("gbv_load_directory: Erro ao ler diretorio.\n");
+            free (lib->docs);
+            lib->docs = NULL;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Monta o caminho do snapshot: '<archive>@<snapname>'
+ * Recebe como parametro:
+ * - Nome do arquivo container (archive)
+ * - Nome do snapshot (snapname)
+ * - Buffer de saida com MAX_ARCHIVE_PATH bytes (path)
+ * return 0 sucesso, -1 erro
+ */
+static int gbv_snapshot_path (const char *archive, const char *snapname, char *path) {
+    if (!gbv_valid_snapshot_name (snapname)) {
+        printf ("Erro: Nome de snapshot invalido: '%s'.\n", snapname);
+        return -1;
+    }
+
+    int len = snprintf (path, MAX_ARCHIVE_PATH, "%s%c%s", archive, SNAPSHOT_SEP, snapname);
+    if (len < 0 || len >= MAX_ARCHIVE_PATH) {
+        printf ("Erro: Caminho do snapshot muito longo.\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Nome de snapshot valido: nao vazio, sem '/' e sem SNAPSHOT_SEP
+static int gbv_valid_snapshot_name (const char *snapname) {
+    return snapname[0] != '\0' && strchr (snapname, '/') == NULL
+           && strchr (snapname, SNAPSHOT_SEP) == NULL;
+}
+
+/**
+ * Recusa operacoes de escrita quando a biblioteca aberta e um snapshot
+ * Recebe como parametro:
+ * - Nome da funcao chamadora, para a mensagem de erro (who)
+ * return 0 se pode escrever, -1 caso contrario
+ */
+static int gbv_check_writable (const char *who) {
+    if (GBV_READ_ONLY) {
+        printf ("%s: Erro: '%s' e um snapshot somente leitura.\n", who, GBV_ARCHIVE_NAME);
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * Grava os metadados da memoria para disco
  * Recebe como parametro:
@@ -551,6 +779,204 @@ static int gbv_persist_metadata (Library *lib) {
     return 0;
 }
 
+//---------------------------------------------------------------------------------------------------------//
+// CACHE DE BLOCOS DA VISUALIZACAO
+//---------------------------------------------------------------------------------------------------------//
+
+/**
+ * Prepara a cache de blocos para um documento
+ * Recebe como parametro:
+ * - Ponteiro para a cache (cache)
+ * - Arquivo container aberto para leitura (fp)
+ * - Offset e tamanho do documento no container (doc_offset, doc_size)
+ * - Tamanho de cada bloco (block_size)
+ * return 0 sucesso, -1 erro
+ */
+static int view_cache_init (GBV_ViewCache *cache, FILE *fp, long doc_offset, long doc_size, long block_size) {
+    cache->fp = fp;
+    cache->doc_offset = doc_offset;
+    cache->doc_size = doc_size;
+    cache->block_size = block_size;
+    cache->tick = 0;
+    cache->hinted = -1;
+
+    cache->area = (char *) malloc ((size_t) block_size * GBV_CACHE_PAGES);
+    cache->scratch = (char *) malloc ((size_t) block_size * GBV_READAHEAD);
+    if (cache->area == NULL || cache->scratch == NULL) {
+        free (cache->area);
+        free (cache->scratch);
+        return -1;
+    }
+
+    for (int i = 0; i < GBV_CACHE_PAGES; i++) {
+        cache->pages[i].block = -1;
+        cache->pages[i].len = 0;
+        cache->pages[i].last_use = 0;
+        cache->pages[i].data = cache->area + (size_t) i * block_size;
+    }
+
+    // A cache ja faz o buffer dos blocos, evita a copia extra do stdio
+    setvbuf (fp, NULL, _IONBF, 0);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    // Indica ao kernel que o documento sera percorrido em sequencia
+    posix_fadvise (fileno (fp), doc_offset, doc_size, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    return 0;
+}
+
+// Libera a memoria das paginas da cache
+static void view_cache_free (GBV_ViewCache *cache) {
+    free (cache->area);
+    free (cache->scratch);
+    cache->area = NULL;
+    cache->scratch = NULL;
+}
+
+// Procura um bloco na cache, return a pagina ou NULL se ausente
+static GBV_CachePage *view_cache_lookup (GBV_ViewCache *cache, long block) {
+    for (int i = 0; i < GBV_CACHE_PAGES; i++) {
+        if (cache->pages[i].block == block) {
+            return &cache->pages[i];
+        }
+    }
+    return NULL;
+}
+
+// Escolhe a pagina a ser reutilizada: uma livre ou a usada ha mais tempo (LRU)
+static GBV_CachePage *view_cache_victim (GBV_ViewCache *cache) {
+    GBV_CachePage *victim = &cache->pages[0];
+    for (int i = 0; i < GBV_CACHE_PAGES; i++) {
+        if (cache->pages[i].block == -1) {
+            return &cache->pages[i];
+        }
+        if (cache->pages[i].last_use < victim->last_use) {
+            victim = &cache->pages[i];
+        }
+    }
+    return victim;
+}
+
+// Sugere ao kernel carregar uma faixa de blocos do documento
+static void view_cache_hint (GBV_ViewCache *cache, long first, long count) {
+#ifdef POSIX_FADV_WILLNEED
+    long last_block = (cache->doc_size - 1) / cache->block_size;
+    if (first < 0) {
+        count += first;
+        first = 0;
+    }
+    if (first > last_block || count <= 0) {
+        return;
+    }
+    posix_fadvise (fileno (cache->fp), cache->doc_offset + first * cache->block_size,
+                   count * cache->block_size, POSIX_FADV_WILLNEED);
+#else
+    (void) cache;
+    (void) first;
+    (void) count;
+#endif
+}
+
+/**
+ * Envia a dica de leitura para a janela logo apos o trecho ja em cache
+ * Procura o primeiro bloco ausente em ate GBV_READAHEAD passos na direcao da navegacao;
+ * se todos estao em cache a dica fica para quando o usuario se aproximar do fim deles
+ */
+static void view_cache_prefetch (GBV_ViewCache *cache, long block, int direction) {
+    long step = direction >= 0 ? 1 : -1;
+    long next = block + step;
+    for (int i = 0; i < GBV_READAHEAD; i++, next += step) {
+        if (view_cache_lookup (cache, next) == NULL) {
+            long first = step > 0 ? next : next - GBV_READAHEAD + 1;
+            if (first != cache->hinted) {
+                view_cache_hint (cache, first, GBV_READAHEAD);
+                cache->hinted = first;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Le 'count' blocos contiguos a partir de 'first' com um unico fseek/fread
+ * e distribui os blocos ainda ausentes entre as paginas da cache
+ * return 0 sucesso, -1 erro
+ */
+static int view_cache_fill (GBV_ViewCache *cache, long first, long count) {
+    long start = first * cache->block_size;
+    long to_read = count * cache->block_size;
+    if (start + to_read > cache->doc_size) {
+        to_read = cache->doc_size - start;
+    }
+
+    if (fseek (cache->fp, cache->doc_offset + start, SEEK_SET) != 0) {
+        return -1;
+    }
+    size_t bytes_read = fread (cache->scratch, 1, (size_t) to_read, cache->fp);
+    if (bytes_read == 0) {
+        return -1;
+    }
+
+    for (long i = 0; i < count; i++) {
+        size_t block_start = (size_t) (i * cache->block_size);
+        if (block_start >= bytes_read) {
+            break;
+        }
+
+        GBV_CachePage *page = view_cache_lookup (cache, first + i);
+        if (page == NULL) {
+            page = view_cache_victim (cache);
+            size_t len = bytes_read - block_start;
+            page->block = first + i;
+            page->len = len < (size_t) cache->block_size ? len : (size_t) cache->block_size;
+            memcpy (page->data, cache->scratch + block_start, page->len);
+        }
+        page->last_use = ++cache->tick;
+    }
+
+    return 0;
+}
+
+/**
+ * Obtem um bloco do documento, lendo do disco apenas em caso de falta
+ * Na falta le GBV_READAHEAD blocos na direcao da navegacao de uma vez
+ * Recebe como parametro:
+ * - Ponteiro para a cache (cache)
+ * - Indice do bloco desejado (block)
+ * - Direcao da navegacao: 1 para frente, -1 para tras (direction)
+ * return pagina com o bloco, NULL em erro
+ */
+static GBV_CachePage *view_cache_get (GBV_ViewCache *cache, long block, int direction) {
+    GBV_CachePage *page = view_cache_lookup (cache, block);
+    if (page == NULL) {
+        long last_block = (cache->doc_size - 1) / cache->block_size;
+        long first, count;
+        if (direction >= 0) {
+            first = block;
+            count = last_block - block + 1 < GBV_READAHEAD ? last_block - block + 1 : GBV_READAHEAD;
+        } else {
+            first = block - GBV_READAHEAD + 1 > 0 ? block - GBV_READAHEAD + 1 : 0;
+            count = block - first + 1;
+        }
+
+        if (view_cache_fill (cache, first, count) != 0) {
+            return NULL;
+        }
+
+        page = view_cache_lookup (cache, block);
+        if (page == NULL) {
+            return NULL;
+        }
+    }
+
+    // Antecipa para o kernel a janela seguinte enquanto o usuario le, tambem em acertos
+    view_cache_prefetch (cache, block, direction);
+
+    page->last_use = ++cache->tick;
+    return page;
+}
+
 //---------------------------------------------------------------------------------------------------------//
 // FUNÇÕES DE COMPARAÇÃO PARA qsort
 //---------------------------------------------------------------------------------------------------------//
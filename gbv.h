@@ -4,11 +4,18 @@
 #include <time.h>
 
 #define MAX_NAME 256
-#define BUFFER_SIZE 512   // tamanho fixo do buffer em bytes
+#define BUFFER_SIZE 512   // tamanho padrao do buffer/bloco em bytes
+
+// Limites para o tamanho de bloco configuravel da visualizacao (-v)
+#define MIN_VIEW_BLOCK 16
+#define MAX_VIEW_BLOCK (64 * 1024)
 
 // Tam maximo para guardar nome do arquivo
 #define MAX_ARCHIVE_PATH 512
 
+// Separador entre o container e o nome do snapshot (ex.: biblioteca.gbv@antes)
+#define SNAPSHOT_SEP '@'
+
 // Estrutura de metadados de cada documento
 typedef struct {
     char name[MAX_NAME];   // nome do documento
@@ -38,6 +45,13 @@ int gbv_list(const Library *lib);
 int gbv_view(const Library *lib, const char *docname);
 int gbv_order(Library *lib, const char *archive, const char *criteria);
 
+// Define o tamanho do bloco usado por gbv_view (padrao BUFFER_SIZE)
+int gbv_set_view_block_size(long size);
+
+// Snapshots copy-on-write do container
+int gbv_snapshot(const char *archive, const char *snapname);
+int gbv_open_snapshot(Library *lib, const char *archive, const char *snapname);
+
 //Funcao auxiliar para liberar a memoria                                                                               
 void gbv_close (Library *lib); //verificar se podemos fazer isso 
 
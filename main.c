@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "gbv.h"
 
@@ -11,26 +12,61 @@ int main(int argc, char *argv[]) {
     const char *opcao = argv[1];
     const char *biblioteca = argv[2];
 
+    int first = 3; // indice do primeiro argumento da opcao
+
+    // Snapshot e tratado antes de gbv_open para nunca criar uma biblioteca vazia
+    if (strcmp(opcao, "-s") == 0) {
+        if (argc < 4) {
+            printf("Opção inválida.\n");
+            return 1;
+        }
+        return gbv_snapshot(biblioteca, argv[3]) == 0 ? 0 : 1;
+    }
+
     Library lib;
-    if (gbv_open(&lib, biblioteca) != 0) {
+    if (strcmp(opcao, "-S") == 0) {
+        // -S <biblioteca> <snapshot> <opção> [...]: executa a opção no snapshot, somente leitura
+        if (argc < 5) {
+            printf("Uso: %s -S <biblioteca> <snapshot> <opção> [documentos...]\n", argv[0]);
+            return 1;
+        }
+        if (gbv_open_snapshot(&lib, biblioteca, argv[3]) != 0) {
+            printf("Erro ao abrir snapshot '%s' da biblioteca %s\n", argv[3], biblioteca);
+            return 1;
+        }
+        opcao = argv[4];
+        first = 5;
+    } else if (gbv_open(&lib, biblioteca) != 0) {
         printf("Erro ao abrir biblioteca %s\n", biblioteca);
         return 1;
     }
 
     if (strcmp(opcao, "-a") == 0) {
-        for (int i = 3; i < argc; i++) {
+        for (int i = first; i < argc; i++) {
             gbv_add(&lib, biblioteca, argv[i]);
         }
     } else if (strcmp(opcao, "-r") == 0) {
-        for (int i = 3; i < argc; i++) {
+        for (int i = first; i < argc; i++) {
             gbv_remove(&lib, argv[i]);
         }
     } else if (strcmp(opcao, "-l") == 0) {
         gbv_list(&lib);
-    } else if (strcmp(opcao, "-v") == 0 && argc >= 4) {
-        gbv_view(&lib, argv[3]);
-    } else if (strcmp(opcao, "-o") == 0 && argc >= 4) {
-        gbv_order(&lib, biblioteca, argv[3]);
+    } else if (strcmp(opcao, "-v") == 0 && argc > first) {
+        // Tamanho de bloco opcional: -v <biblioteca> <documento> [tam_bloco]
+        if (argc > first + 1) {
+            char *end;
+            long block_size = strtol(argv[first + 1], &end, 10);
+            if (end == argv[first + 1] || *end != '\0') {
+                printf("Tamanho de bloco inválido: '%s'.\n", argv[first + 1]);
+                return 1;
+            }
+            if (gbv_set_view_block_size(block_size) != 0) {
+                return 1;
+            }
+        }
+        gbv_view(&lib, argv[first]);
+    } else if (strcmp(opcao, "-o") == 0 && argc > first) {
+        gbv_order(&lib, biblioteca, argv[first]);
     } else {
         printf("Opção inválida.\n");
     }
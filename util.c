@@ -1,9 +1,144 @@
+// Necessario para copy_file_range, SEEK_DATA/SEEK_HOLE e FICLONE
+#define _GNU_SOURCE
+
 #include "util.h"
 #include <stdio.h>
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+// copy_file_range existe a partir da glibc 2.27
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#define HAVE_COPY_FILE_RANGE 1
+#endif
 
 void format_date(time_t t, char *buffer, int max) {
     struct tm *info = localtime(&t);
     strftime(buffer, max, "%d/%m/%Y %H:%M:%S", info);
 }
 
+// Copia um intervalo entre arquivos na mesma posicao, de preferencia dentro do kernel
+static int copy_range(int in_fd, int out_fd, off_t offset, off_t len) {
+#ifdef HAVE_COPY_FILE_RANGE
+    // No btrfs/XFS o kernel compartilha os blocos em vez de copia-los
+    while (len > 0) {
+        off_t in_off = offset, out_off = offset;
+        ssize_t n = copy_file_range(in_fd, &in_off, out_fd, &out_off, (size_t) len, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)
+                break; // sem suporte, usa pread/pwrite abaixo
+            return -1;
+        }
+        if (n == 0)
+            return 0;
+        offset += n;
+        len -= n;
+    }
+#endif
+
+    char buffer[64 * 1024];
+    while (len > 0) {
+        size_t chunk = len < (off_t) sizeof(buffer) ? (size_t) len : sizeof(buffer);
+        ssize_t n = pread(in_fd, buffer, chunk, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            break;
+
+        ssize_t written = 0;
+        while (written < n) {
+            ssize_t w = pwrite(out_fd, buffer + written, n - written, offset + written);
+            if (w < 0) {
+                if (errno == EINTR)
+                    continue;
+                return -1;
+            }
+            written += w;
+        }
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Copia apenas as regioes com dados, mantendo os buracos do arquivo de origem
+static int sparse_copy(int in_fd, int out_fd, off_t size) {
+    off_t pos = 0;
+    while (pos < size) {
+        off_t data = pos, hole = size;
+#ifdef SEEK_DATA
+        data = lseek(in_fd, pos, SEEK_DATA);
+        if (data < 0 && errno == ENXIO)
+            break; // resto do arquivo e buraco
+        if (data < 0) {
+            data = pos; // sistema de arquivos sem suporte, copia tudo
+        } else {
+            hole = lseek(in_fd, data, SEEK_HOLE);
+            if (hole < 0 || hole > size)
+                hole = size;
+        }
+#endif
+        if (copy_range(in_fd, out_fd, data, hole - data) != 0)
+            return -1;
+        pos = hole;
+    }
+    // Garante o tamanho final mesmo quando o arquivo termina em buraco
+    return ftruncate(out_fd, size);
+}
+
+int clone_file(const char *src, const char *dst, int *reflinked) {
+    *reflinked = 0;
+
+    int in_fd = open(src, O_RDONLY);
+    if (in_fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(in_fd, &st) != 0) {
+        close(in_fd);
+        return -1;
+    }
+
+    // Copia criada somente leitura e nunca sobrescreve um arquivo existente
+    int out_fd = open(dst, O_WRONLY | O_CREAT | O_EXCL, 0444);
+    if (out_fd < 0) {
+        close(in_fd);
+        return -1;
+    }
+
+    int status = -1;
+#ifdef FICLONE
+    // Reflink: compartilha todos os blocos, custo independente do tamanho
+    if (ioctl(out_fd, FICLONE, in_fd) == 0) {
+        *reflinked = 1;
+        status = 0;
+    }
+#endif
+    if (status != 0)
+        status = sparse_copy(in_fd, out_fd, st.st_size);
+    if (status == 0)
+        status = fsync(out_fd);
+
+    int saved_errno = errno;
+    close(in_fd);
+    if (close(out_fd) != 0 && status == 0) {
+        saved_errno = errno;
+        status = -1;
+    }
+    if (status != 0) {
+        unlink(dst);
+        errno = saved_errno;
+    }
+    return status;
+}
@@ -6,5 +6,10 @@
 // Converte time_t para string formatada
 void format_date(time_t t, char *buffer, int max);
 
+// Clona src em dst (novo arquivo somente leitura) via reflink quando possivel,
+// senao faz uma copia que preserva buracos. reflinked indica se houve reflink.
+// return 0 sucesso, -1 erro (errno preservado)
+int clone_file(const char *src, const char *dst, int *reflinked);
+
 #endif
 